@@ -0,0 +1,158 @@
+// ===============================
+// SPRITE ATLAS PACKER
+// ===============================
+// Offline tool run by "make atlas". Cuts every sheet listed in the manifest
+// into its frames, shelf-packs them into at most MAX_PAGES atlas pages and
+// writes the frame table read by SpriteAtlas in Dino_game.cpp.
+//
+//   atlas_packer textures/atlas_sheets.txt textures
+//
+// Table format (path last because file names contain spaces):
+//   P <page> <atlas path>
+//   F <page> <frame> <x> <y> <w> <h> <sheet path>
+#include "raylib.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+const int PAGE_SIZE = 4096;
+const int MAX_PAGES = 2;
+const int PADDING = 2;
+
+struct Sheet {
+    std::string path;
+    int frameCount = 1;
+    Image image{};
+    int frameWidth = 0;
+    int frameHeight = 0;
+    int page = -1;
+    std::vector<Rectangle> placed;
+};
+
+// Rows of frames filled left to right; a new row starts under the tallest
+// frame of the previous one
+struct ShelfPacker {
+    int x = 0;
+    int y = 0;
+    int rowHeight = 0;
+    
+    bool Place(int w, int h, Rectangle& out) {
+        if (x + w > PAGE_SIZE) {
+            x = 0;
+            y += rowHeight + PADDING;
+            rowHeight = 0;
+        }
+        if (w > PAGE_SIZE || y + h > PAGE_SIZE) return false;
+        out = {(float)x, (float)y, (float)w, (float)h};
+        x += w + PADDING;
+        rowHeight = std::max(rowHeight, h);
+        return true;
+    }
+    
+    int UsedHeight() const { return y + rowHeight; }
+};
+
+static bool ReadManifest(const char* file, std::vector<Sheet>& sheets) {
+    std::ifstream in(file);
+    if (!in) return false;
+    
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream row(line);
+        Sheet sheet;
+        row >> sheet.frameCount;
+        std::getline(row >> std::ws, sheet.path);
+        if (sheet.frameCount > 0 && !sheet.path.empty()) sheets.push_back(sheet);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printf("usage: atlas_packer <manifest> <output dir>\n");
+        return 1;
+    }
+    
+    std::vector<Sheet> sheets;
+    if (!ReadManifest(argv[1], sheets)) {
+        printf("atlas_packer: cannot read %s\n", argv[1]);
+        return 1;
+    }
+    
+    for (auto& sheet : sheets) {
+        sheet.image = LoadImage(sheet.path.c_str());
+        sheet.frameWidth = sheet.image.width / sheet.frameCount;
+        sheet.frameHeight = sheet.image.height;
+    }
+    
+    // Tallest frames first keeps the shelves tight. A sheet never spans two
+    // pages, so one Animation only ever binds one texture.
+    std::vector<Sheet*> order;
+    for (auto& sheet : sheets) {
+        if (sheet.image.data) order.push_back(&sheet);
+        else printf("atlas_packer: skipping %s (cannot load)\n", sheet.path.c_str());
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](const Sheet* a, const Sheet* b) { return a->frameHeight > b->frameHeight; });
+    
+    ShelfPacker pages[MAX_PAGES];
+    for (Sheet* sheet : order) {
+        for (int p = 0; p < MAX_PAGES && sheet->page < 0; p++) {
+            ShelfPacker attempt = pages[p];
+            std::vector<Rectangle> placed(sheet->frameCount);
+            bool fits = true;
+            for (int f = 0; f < sheet->frameCount && fits; f++) {
+                fits = attempt.Place(sheet->frameWidth, sheet->frameHeight, placed[f]);
+            }
+            if (fits) {
+                pages[p] = attempt;
+                sheet->page = p;
+                sheet->placed = placed;
+            }
+        }
+        if (sheet->page < 0) printf("atlas_packer: %s left loose (atlas full)\n", sheet->path.c_str());
+    }
+    
+    std::string outDir = argv[2];
+    std::ofstream table(outDir + "/atlas.txt");
+    for (int p = 0; p < MAX_PAGES; p++) {
+        if (pages[p].UsedHeight() == 0) continue;
+        
+        // Round the page height up to a power of two
+        int height = 1;
+        while (height < pages[p].UsedHeight()) height *= 2;
+        Image page = GenImageColor(PAGE_SIZE, height, BLANK);
+        
+        for (Sheet* sheet : order) {
+            if (sheet->page != p) continue;
+            for (int f = 0; f < sheet->frameCount; f++) {
+                Rectangle src = {(float)(f * sheet->frameWidth), 0, (float)sheet->frameWidth, (float)sheet->frameHeight};
+                ImageDraw(&page, sheet->image, src, sheet->placed[f], WHITE);
+            }
+        }
+        
+        std::string pagePath = outDir + "/atlas_" + std::to_string(p) + ".png";
+        ExportImage(page, pagePath.c_str());
+        UnloadImage(page);
+        table << "P " << p << " " << pagePath << "\n";
+        printf("atlas_packer: %s %dx%d\n", pagePath.c_str(), PAGE_SIZE, height);
+    }
+    
+    for (Sheet* sheet : order) {
+        if (sheet->page < 0) continue;
+        for (int f = 0; f < sheet->frameCount; f++) {
+            const Rectangle& r = sheet->placed[f];
+            table << "F " << sheet->page << " " << f << " " << (int)r.x << " " << (int)r.y << " "
+                  << (int)r.width << " " << (int)r.height << " " << sheet->path << "\n";
+        }
+    }
+    
+    for (auto& sheet : sheets) {
+        if (sheet.image.data) UnloadImage(sheet.image);
+    }
+    return 0;
+}
@@ -1,5 +1,334 @@
 #include "raylib.h"
 #include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstdarg>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#if !defined(_WINDOWS_)
+//windows.h clashes with raylib, declare only what the mapping needs
+extern "C" {
+__declspec(dllimport) void* __stdcall CreateFileA(const char*, unsigned long, unsigned long, void*,
+                                                  unsigned long, unsigned long, void*);
+__declspec(dllimport) void* __stdcall CreateFileMappingA(void*, void*, unsigned long, unsigned long,
+                                                         unsigned long, const char*);
+__declspec(dllimport) void* __stdcall MapViewOfFile(void*, unsigned long, unsigned long, unsigned long, size_t);
+__declspec(dllimport) int __stdcall UnmapViewOfFile(const void*);
+__declspec(dllimport) int __stdcall CloseHandle(void*);
+}
+#endif
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//assets.pak is written by "make pack" (tools/asset_packer.cpp) and mapped
+//once at startup, assets decode straight from the mapping. Files missing
+//from the pack (or no pack) load loose. Set GLINO_LOOSE_ASSETS to let loose
+//files newer than the pack replace their packed copy, no repack needed.
+struct PackHeader
+{
+    char magic[4];
+    uint32_t count;
+};
+
+struct PackEntry
+{
+    uint32_t offset;
+    uint32_t size;
+    char path[120];
+};
+
+//read-only mapping of a whole file
+struct MappedFile
+{
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+    
+    bool Open(const char* path)
+    {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        fseek(f, 0, SEEK_END);
+        long length = ftell(f);
+        fclose(f);
+        if (length <= 0) return false;
+        size = (size_t)length;
+#if defined(_WIN32)
+        file = CreateFileA(path, 0x80000000UL /* GENERIC_READ */, 1 /* FILE_SHARE_READ */, nullptr,
+                           3 /* OPEN_EXISTING */, 0x80 /* FILE_ATTRIBUTE_NORMAL */, nullptr);
+        if (file == (void*)(intptr_t)-1)
+        {
+            file = nullptr;
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, 2 /* PAGE_READONLY */, 0, 0, nullptr);
+        if (mapping) data = (const unsigned char*)MapViewOfFile(mapping, 4 /* FILE_MAP_READ */, 0, 0, 0);
+#else
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return false;
+        void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (view != MAP_FAILED) data = (const unsigned char*)view;
+#endif
+        if (!data) Close();
+        return data != nullptr;
+    }
+    
+    void Close()
+    {
+#if defined(_WIN32)
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file) CloseHandle(file);
+        file = mapping = nullptr;
+#else
+        if (data) munmap((void*)data, size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+};
+
+struct AssetPack
+{
+    MappedFile file;
+    const PackEntry* entries = nullptr;
+    uint32_t count = 0;
+    long modTime = 0;
+    std::vector<unsigned char> shadowed; //per entry: a newer loose copy wins
+    
+    bool Open(const char* path)
+    {
+        if (!file.Open(path)) return false;
+        modTime = GetFileModTime(path);
+        
+        PackHeader header;
+        bool valid = file.size >= sizeof(header);
+        if (valid)
+        {
+            memcpy(&header, file.data, sizeof(header));
+            valid = memcmp(header.magic, "GPK1", 4) == 0 &&
+                    file.size >= sizeof(header) + (size_t)header.count * sizeof(PackEntry);
+        }
+        if (!valid)
+        {
+            TraceLog(LOG_WARNING, "ASSET PACK: %s is not a valid pack, using loose files", path);
+            file.Close();
+            return false;
+        }
+        
+        entries = (const PackEntry*)(file.data + sizeof(header));
+        count = header.count;
+        TraceLog(LOG_INFO, "ASSET PACK: %s mapped, %u files", path, count);
+        FindLooseOverrides();
+        return true;
+    }
+    
+    void Close()
+    {
+        file.Close();
+        entries = nullptr;
+        count = 0;
+        shadowed.clear();
+    }
+    
+    //dev only (GLINO_LOOSE_ASSETS), one stat per file here so Find never
+    //touches the file system
+    void FindLooseOverrides()
+    {
+        shadowed.assign(count, 0);
+        if (!getenv("GLINO_LOOSE_ASSETS")) return;
+        int overrides = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            struct stat info;
+            if (stat(entries[i].path, &info) == 0 && (long)info.st_mtime > modTime)
+            {
+                shadowed[i] = 1;
+                overrides++;
+            }
+        }
+        TraceLog(LOG_INFO, "ASSET PACK: %d loose file(s) newer than the pack", overrides);
+    }
+    
+    //index is sorted by path: binary search
+    const unsigned char* Find(const char* path, int* size) const
+    {
+        uint32_t lo = 0, hi = count;
+        while (lo < hi)
+        {
+            uint32_t mid = (lo + hi) / 2;
+            int order = strcmp(entries[mid].path, path);
+            if (order == 0)
+            {
+                if ((size_t)entries[mid].offset + entries[mid].size > file.size) return nullptr;
+                if (shadowed[mid]) return nullptr;
+                *size = (int)entries[mid].size;
+                return file.data + entries[mid].offset;
+            }
+            if (order < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        return nullptr;
+    }
+};
+
+AssetPack assetPack;
+
+Sound LoadSoundAsset(const char* path)
+{
+    int size = 0;
+    const unsigned char* data = assetPack.Find(path, &size);
+    if (!data) return LoadSound(path);
+    Wave wave = LoadWaveFromMemory(GetFileExtension(path), data, size);
+    Sound sound = LoadSoundFromWave(wave);
+    UnloadWave(wave);
+    return sound;
+}
+
+//the stream reads from the mapping, keep the pack open until the music is
+//unloaded
+Music LoadMusicAsset(const char* path)
+{
+    int size = 0;
+    const unsigned char* data = assetPack.Find(path, &size);
+    return data ? LoadMusicStreamFromMemory(GetFileExtension(path), data, size) : LoadMusicStream(path);
+}
+
+//Decoded texture cache: cache/<path hash>.tex is a header + raw pixels,
+//mapped and uploaded on the next start with no PNG decode. Keyed on the
+//source's size+mtime (or pack entry) so a warm start never reads the PNGs.
+//Textures all load once at startup on the main thread.
+#define DECODED_CACHE_DIR "cache"
+
+struct DecodedHeader
+{
+    char magic[4];
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t dataSize;
+    uint32_t reserved;
+    uint64_t sourceKey;
+};
+
+uint64_t HashBytes(const unsigned char* data, size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//pack offset+size+pack mtime, or loose size+mtime; 0 if missing
+uint64_t DecodedSourceKey(const char* path)
+{
+    int size = 0;
+    const unsigned char* packed = assetPack.Find(path, &size);
+    uint64_t stamp[3] = {0, 0, 0};
+    if (packed)
+    {
+        stamp[0] = (uint64_t)(packed - assetPack.file.data);
+        stamp[1] = (uint64_t)size;
+        stamp[2] = (uint64_t)assetPack.modTime;
+    }
+    else
+    {
+        struct stat info;
+        if (stat(path, &info) != 0) return 0;
+        stamp[1] = (uint64_t)info.st_size;
+        stamp[2] = (uint64_t)info.st_mtime;
+    }
+    return HashBytes((const unsigned char*)stamp, sizeof(stamp)) | 1;
+}
+
+//write to .tmp then rename, so a torn write never looks like a valid entry
+void WriteDecodedCache(const char* cachePath, Image image, uint64_t sourceKey)
+{
+#if defined(_WIN32)
+    _mkdir(DECODED_CACHE_DIR);
+#else
+    mkdir(DECODED_CACHE_DIR, 0755);
+#endif
+    char tempPath[96];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", cachePath);
+    FILE* f = fopen(tempPath, "wb");
+    if (!f) return;
+
+    DecodedHeader header = {{'G', 'T', 'X', '2'}, (uint32_t)image.width, (uint32_t)image.height,
+                            (uint32_t)image.format, (uint32_t)GetPixelDataSize(image.width, image.height, image.format),
+                            0, sourceKey};
+    bool written = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                   fwrite(image.data, 1, header.dataSize, f) == header.dataSize;
+    written = fclose(f) == 0 && written;
+#if defined(_WIN32)
+    if (written) remove(cachePath); //rename doesn't replace on Windows
+#endif
+    if (!written || rename(tempPath, cachePath) != 0) remove(tempPath);
+}
+
+Texture2D LoadTextureCached(const char* path)
+{
+    uint64_t sourceKey = DecodedSourceKey(path);
+    if (sourceKey == 0) return Texture2D{};
+
+    char cachePath[64];
+    snprintf(cachePath, sizeof(cachePath), DECODED_CACHE_DIR "/%016llx.tex",
+             (unsigned long long)HashBytes((const unsigned char*)path, strlen(path)));
+    MappedFile mapping;
+    if (mapping.Open(cachePath))
+    {
+        DecodedHeader header;
+        bool valid = mapping.size >= sizeof(header);
+        if (valid)
+        {
+            memcpy(&header, mapping.data, sizeof(header));
+            valid = memcmp(header.magic, "GTX2", 4) == 0 && header.sourceKey == sourceKey &&
+                    mapping.size >= sizeof(header) + header.dataSize;
+        }
+        if (valid)
+        {
+            Image image = {(void*)(mapping.data + sizeof(header)), (int)header.width, (int)header.height, 1,
+                           (int)header.format};
+            Texture2D texture = LoadTextureFromImage(image);
+            mapping.Close();
+            return texture;
+        }
+        mapping.Close();
+    }
+
+    //missing or stale: decode the source and rewrite the entry
+    int sourceSize = 0;
+    const unsigned char* packed = assetPack.Find(path, &sourceSize);
+    unsigned char* loose = packed ? nullptr : LoadFileData(path, &sourceSize);
+    const unsigned char* source = packed ? packed : loose;
+    if (!source) return Texture2D{};
+    Image image = LoadImageFromMemory(GetFileExtension(path), source, sourceSize);
+    if (loose) UnloadFileData(loose);
+    if (!image.data) return Texture2D{};
+    WriteDecodedCache(cachePath, image, sourceKey);
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    return texture;
+}
+
 
 struct AnimData
 {
@@ -30,8 +359,117 @@ AnimData updateAnimData(AnimData data, float dT, int maxFrame)
     return data;
 }
 
-int main()
+//Frame arena: per-frame strings go into one fixed block, reset after
+//BeginDrawing. highWater is the most a frame has used, to size the block.
+const int FRAME_ARENA_BYTES = 1024;
+
+struct FrameArena
 {
+    char data[FRAME_ARENA_BYTES];
+    int used = 0;
+    int highWater = 0;
+    int overflows = 0;
+
+    void Reset()
+    {
+        used = 0;
+    }
+
+    //printf into the arena, empty string when the block is full
+    const char* Format(const char* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(data + used, FRAME_ARENA_BYTES - used, format, args);
+        va_end(args);
+        if (length < 0 || used + length + 1 > FRAME_ARENA_BYTES)
+        {
+            overflows++;
+            return "";
+        }
+        const char* text = data + used;
+        used += length + 1;
+        highWater = std::max(highWater, used);
+        return text;
+    }
+};
+
+FrameArena frameArena;
+
+//Microbenchmarks: "game --bench [file.json]" (or "make bench") times
+//updateAnimData on one animation (realistic) and on 10000 (stress).
+//Prints a table and writes Google Benchmark style JSON.
+struct BenchResult
+{
+    const char* name;
+    long long iterations;
+    double nsPerOp;
+    long long items;
+};
+
+//doubles the iteration count until one run lasts at least 0.2 s
+BenchResult BenchAnimData(const char* name, int count)
+{
+    std::vector<AnimData> anims(count);
+    for (int i = 0; i < count; i++)
+    {
+        anims[i] = {};
+        anims[i].rec = {0, 0, 64, 64};
+        anims[i].updateTime = 1.0f / (10 + i % 7);
+    }
+    for (long long iterations = 1;; iterations *= 2)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < iterations; i++)
+        {
+            for (AnimData& a : anims) a = updateAnimData(a, 1.0f / 60.0f, 3);
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (ns >= 2.0e8)
+        {
+            printf("%-32s %14.1f ns/op %12lld iterations\n", name, ns / iterations, iterations);
+            return {name, iterations, ns / iterations, count};
+        }
+    }
+}
+
+int RunMicroBenchmarks(const char* jsonFile)
+{
+    BenchResult results[] = {BenchAnimData("updateAnimData/realistic", 1),
+                             BenchAnimData("updateAnimData/stress", 10000)};
+    const int count = sizeof(results) / sizeof(results[0]);
+    
+    FILE* f = fopen(jsonFile, "w");
+    if (!f)
+    {
+        printf("bench: cannot write %s\n", jsonFile);
+        return 1;
+    }
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    fprintf(f, "{\n  \"context\": {\"date\": \"%s\", \"executable\": \"Glino\", \"num_cpus\": %u},\n",
+            date, std::thread::hardware_concurrency());
+    fprintf(f, "  \"benchmarks\": [\n");
+    for (int i = 0; i < count; i++)
+    {
+        fprintf(f, "    {\"name\": \"%s\", \"iterations\": %lld, \"real_time\": %.3f, \"time_unit\": \"ns\", "
+                "\"items_per_iteration\": %lld}%s\n",
+                results[i].name, results[i].iterations, results[i].nsPerOp, results[i].items, i + 1 < count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    printf("bench: results written to %s\n", jsonFile);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        return RunMicroBenchmarks(argc > 2 ? argv[2] : "bench.json");
+    }
+    
     int WindowDimensions [2];
     WindowDimensions [0] = 1280;
     WindowDimensions [1] = 720;
@@ -42,15 +480,18 @@ int main()
 
     InitWindow(WindowDimensions[0], WindowDimensions[1], "Glino");
        
+    //Assets: one mapped pack, loose files when it is missing
+    assetPack.Open("assets.pak");
+
     //Sounds
     InitAudioDevice();
-    Sound Jump = LoadSound("Sounds/jump.wav");
-    Sound melonPickUp = LoadSound("Sounds/pickupCoin.wav");
-    Sound kill = LoadSound("Sounds/hitHurt.wav");
-    Music PixelKing = LoadMusicStream("Sounds/Pixel Kings.wav");
+    Sound Jump = LoadSoundAsset("Sounds/jump.wav");
+    Sound melonPickUp = LoadSoundAsset("Sounds/pickupCoin.wav");
+    Sound kill = LoadSoundAsset("Sounds/hitHurt.wav");
+    Music PixelKing = LoadMusicAsset("Sounds/Pixel Kings.wav");
 
     // Texture Backround
-    Texture2D mountain =LoadTexture("textures/mountain.png");
+    Texture2D mountain =LoadTextureCached("textures/mountain.png");
     AnimData mountainData;
     mountainData.rec.width = mountain.width;
     mountainData.rec.height = mountain.height;
@@ -62,7 +503,7 @@ int main()
     mountainData.runntingTime = 0;
     mountainData.updateTime =0;
 
-    Texture2D birds =LoadTexture("textures/birds.png");
+    Texture2D birds =LoadTextureCached("textures/birds.png");
     AnimData birdsData;
     birdsData.rec.width = birds.width;
     birdsData.rec.height = birds.height;
@@ -74,7 +515,7 @@ int main()
     birdsData.runntingTime = 0;
     birdsData.updateTime =0;
 
-    Texture2D treesBack =LoadTexture("textures/treesBack.png");
+    Texture2D treesBack =LoadTextureCached("textures/treesBack.png");
     AnimData treesBackData;
     treesBackData.rec.width = treesBack.width;
     treesBackData.rec.height = treesBack.height;
@@ -86,7 +527,7 @@ int main()
     treesBackData.runntingTime = 0;
     treesBackData.updateTime =0;
 
-Texture2D treesFront =LoadTexture("textures/treesFront.png");
+Texture2D treesFront =LoadTextureCached("textures/treesFront.png");
     AnimData treesFrontData;
     treesFrontData.rec.width = treesFront.width;
     treesFrontData.rec.height = treesFront.height;
@@ -102,7 +543,7 @@ Texture2D treesFront =LoadTexture("textures/treesFront.png");
     
     //Textures Dino
     
-    Texture2D Dino = LoadTexture("textures/dino.png");
+    Texture2D Dino = LoadTextureCached("textures/dino.png");
     AnimData dinoData;
     dinoData.rec.width = Dino.width/4;
     dinoData.rec.height = Dino.height;
@@ -116,7 +557,7 @@ Texture2D treesFront =LoadTexture("textures/treesFront.png");
 
     
     //Texture Laeva
-    Texture2D Laeva = LoadTexture("textures/LAEVA.png");
+    Texture2D Laeva = LoadTextureCached("textures/LAEVA.png");
     const int NumOfLaevas{6};
     int LaevaDist{100};
            
@@ -136,7 +577,7 @@ Texture2D treesFront =LoadTexture("textures/treesFront.png");
     }
     
     //Texture Watermelon
-    Texture2D melon = LoadTexture("textures/Yellow Watermelon2.png");
+    Texture2D melon = LoadTextureCached("textures/Yellow Watermelon2.png");
     const int NumOfMelon{1};
     int MelonDist{1000};
             
@@ -156,8 +597,8 @@ Texture2D treesFront =LoadTexture("textures/treesFront.png");
     }
     //Dino Is ducking
     bool DinoIsDuck{false};
-    // Dino Velocity 
-    int Dino_velocity{0};    
+    // Dino Velocity (float: an int truncated gravity * dt every frame)
+    float Dino_velocity{0};    
     // Dino Jump Hight (pixels/s/s)/frame
     const int jump_hight{800};
     //Gravity (pixels/s/s)/frame
@@ -187,6 +628,7 @@ Texture2D treesFront =LoadTexture("textures/treesFront.png");
     while (!WindowShouldClose())
     {
         BeginDrawing();
+        frameArena.Reset();
         ClearBackground(RED);
     if(Menu)
     {
@@ -231,10 +673,8 @@ Texture2D treesFront =LoadTexture("textures/treesFront.png");
             
 
             DrawText("Game Over, Glino Died :(", windowWidth/2 - 200, 200, 60, RED);
-            std::string points = "Score: ";
             DrawText("ENTER TO RESTART", windowWidth/2 - 200, 300, 60, RED);
-            points.append(std::to_string(pointNum), 0, 999); 
-            DrawText(points.c_str(), windowWidth/2 - 200, 400, 30, BLUE);
+            DrawText(frameArena.Format("Score: %d", pointNum), windowWidth/2 - 200, 400, 30, BLUE);
             StopMusicStream(PixelKing);   
             DrawText("CONTROLS", 
             850, 450, 40, RED);
@@ -327,9 +767,7 @@ Texture2D treesFront =LoadTexture("textures/treesFront.png");
         
         
         
-        std::string points = "Score: ";
-        points.append(std::to_string(pointNum), 0, 999);
-        DrawText(points.c_str(), windowWidth/2 - 200, 100, 30, RED);    
+        DrawText(frameArena.Format("Score: %d", pointNum), windowWidth/2 - 200, 100, 30, RED);
 
                 
         
@@ -531,7 +969,10 @@ Texture2D treesFront =LoadTexture("textures/treesFront.png");
     UnloadTexture(Dino);
     UnloadTexture(Laeva);
     UnloadTexture(melon);
+    TraceLog(LOG_INFO, "FRAME ARENA: high water %d / %d bytes, %d overflows",
+             frameArena.highWater, FRAME_ARENA_BYTES, frameArena.overflows);
     CloseWindow();
+    assetPack.Close();
 
 
 }
\ No newline at end of file
@@ -5,10 +5,343 @@
 #include <ctime>
 #include <cmath>
 #include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <cstdarg>
+#include <chrono>
+#include <thread>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#if !defined(_WINDOWS_)
+// windows.h entre en conflit avec raylib : on ne déclare que ce qu'il faut au mapping
+extern "C" {
+__declspec(dllimport) void* __stdcall CreateFileA(const char*, unsigned long, unsigned long, void*,
+                                                  unsigned long, unsigned long, void*);
+__declspec(dllimport) void* __stdcall CreateFileMappingA(void*, void*, unsigned long, unsigned long,
+                                                         unsigned long, const char*);
+__declspec(dllimport) void* __stdcall MapViewOfFile(void*, unsigned long, unsigned long, unsigned long, size_t);
+__declspec(dllimport) int __stdcall UnmapViewOfFile(const void*);
+__declspec(dllimport) int __stdcall CloseHandle(void*);
+}
+#endif
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// assets.pak est écrit par "make pack" (tools/asset_packer.cpp) et mappé une
+// fois au démarrage ; les assets sont décodés directement depuis le mapping.
+// Un fichier absent du pack, ou l'absence de pack, retombe sur les fichiers
+// libres. Pour modifier un asset sans refaire le pack, définir
+// GLINO_LOOSE_ASSETS : les fichiers libres plus récents que le pack
+// remplacent alors leur copie.
+struct PackHeader
+{
+    char magic[4];
+    uint32_t count;
+};
+
+struct PackEntry
+{
+    uint32_t offset;
+    uint32_t size;
+    char path[120];
+};
+
+// Mapping en lecture seule d'un fichier entier
+struct MappedFile
+{
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+    
+    bool Open(const char* path)
+    {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        fseek(f, 0, SEEK_END);
+        long length = ftell(f);
+        fclose(f);
+        if (length <= 0) return false;
+        size = (size_t)length;
+#if defined(_WIN32)
+        file = CreateFileA(path, 0x80000000UL /* GENERIC_READ */, 1 /* FILE_SHARE_READ */, nullptr,
+                           3 /* OPEN_EXISTING */, 0x80 /* FILE_ATTRIBUTE_NORMAL */, nullptr);
+        if (file == (void*)(intptr_t)-1)
+        {
+            file = nullptr;
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, 2 /* PAGE_READONLY */, 0, 0, nullptr);
+        if (mapping) data = (const unsigned char*)MapViewOfFile(mapping, 4 /* FILE_MAP_READ */, 0, 0, 0);
+#else
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return false;
+        void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (view != MAP_FAILED) data = (const unsigned char*)view;
+#endif
+        if (!data) Close();
+        return data != nullptr;
+    }
+    
+    void Close()
+    {
+#if defined(_WIN32)
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file) CloseHandle(file);
+        file = mapping = nullptr;
+#else
+        if (data) munmap((void*)data, size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+};
+
+struct AssetPack
+{
+    MappedFile file;
+    const PackEntry* entries = nullptr;
+    uint32_t count = 0;
+    long modTime = 0;
+    std::vector<unsigned char> shadowed; // par entrée : une copie libre plus récente
+    
+    bool Open(const char* path)
+    {
+        if (!file.Open(path)) return false;
+        modTime = GetFileModTime(path);
+        
+        PackHeader header;
+        bool valid = file.size >= sizeof(header);
+        if (valid)
+        {
+            memcpy(&header, file.data, sizeof(header));
+            valid = memcmp(header.magic, "GPK1", 4) == 0 &&
+                    file.size >= sizeof(header) + (size_t)header.count * sizeof(PackEntry);
+        }
+        if (!valid)
+        {
+            TraceLog(LOG_WARNING, "ASSET PACK: %s is not a valid pack, using loose files", path);
+            file.Close();
+            return false;
+        }
+        
+        entries = (const PackEntry*)(file.data + sizeof(header));
+        count = header.count;
+        TraceLog(LOG_INFO, "ASSET PACK: %s mapped, %u files", path, count);
+        FindLooseOverrides();
+        return true;
+    }
+    
+    void Close()
+    {
+        file.Close();
+        entries = nullptr;
+        count = 0;
+        shadowed.clear();
+    }
+    
+    // Seulement avec GLINO_LOOSE_ASSETS, et une seule fois par fichier ici :
+    // Find ne touche jamais au système de fichiers
+    void FindLooseOverrides()
+    {
+        shadowed.assign(count, 0);
+        if (!getenv("GLINO_LOOSE_ASSETS")) return;
+        int overrides = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            struct stat info;
+            if (stat(entries[i].path, &info) == 0 && (long)info.st_mtime > modTime)
+            {
+                shadowed[i] = 1;
+                overrides++;
+            }
+        }
+        TraceLog(LOG_INFO, "ASSET PACK: %d loose file(s) newer than the pack", overrides);
+    }
+    
+    // L'index est trié par chemin : recherche dichotomique
+    const unsigned char* Find(const char* path, int* size) const
+    {
+        uint32_t lo = 0, hi = count;
+        while (lo < hi)
+        {
+            uint32_t mid = (lo + hi) / 2;
+            int order = strcmp(entries[mid].path, path);
+            if (order == 0)
+            {
+                if ((size_t)entries[mid].offset + entries[mid].size > file.size) return nullptr;
+                if (shadowed[mid]) return nullptr;
+                *size = (int)entries[mid].size;
+                return file.data + entries[mid].offset;
+            }
+            if (order < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        return nullptr;
+    }
+};
+
+AssetPack assetPack;
+
+Sound LoadSoundAsset(const char* path)
+{
+    int size = 0;
+    const unsigned char* data = assetPack.Find(path, &size);
+    if (!data) return LoadSound(path);
+    Wave wave = LoadWaveFromMemory(GetFileExtension(path), data, size);
+    Sound sound = LoadSoundFromWave(wave);
+    UnloadWave(wave);
+    return sound;
+}
+
+// Le flux lit directement dans le mapping : le pack reste ouvert tant que la
+// musique est chargée
+Music LoadMusicAsset(const char* path)
+{
+    int size = 0;
+    const unsigned char* data = assetPack.Find(path, &size);
+    return data ? LoadMusicStreamFromMemory(GetFileExtension(path), data, size) : LoadMusicStream(path);
+}
+
+// Cache des textures décodées : cache/<hash du chemin>.tex contient un petit
+// en-tête puis les pixels bruts. Au démarrage suivant le fichier est mappé et
+// envoyé au GPU directement depuis le mapping, sans décoder le PNG. La clé de
+// l'en-tête vient de la taille et de la date du fichier source (ou de son
+// entrée dans le pack) : un PNG modifié est redécodé sans qu'il faille relire
+// les sources inchangées. Le jeu charge toutes ses textures une fois, au
+// démarrage, sur le thread principal.
+#define DECODED_CACHE_DIR "cache"
+
+struct DecodedHeader
+{
+    char magic[4];
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t dataSize;
+    uint32_t reserved;
+    uint64_t sourceKey;
+};
+
+uint64_t HashBytes(const unsigned char* data, size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Position dans le pack et date du pack, ou taille et date du fichier libre.
+// 0 si le fichier n'existe pas.
+uint64_t DecodedSourceKey(const char* path)
+{
+    int size = 0;
+    const unsigned char* packed = assetPack.Find(path, &size);
+    uint64_t stamp[3] = {0, 0, 0};
+    if (packed)
+    {
+        stamp[0] = (uint64_t)(packed - assetPack.file.data);
+        stamp[1] = (uint64_t)size;
+        stamp[2] = (uint64_t)assetPack.modTime;
+    }
+    else
+    {
+        struct stat info;
+        if (stat(path, &info) != 0) return 0;
+        stamp[1] = (uint64_t)info.st_size;
+        stamp[2] = (uint64_t)info.st_mtime;
+    }
+    return HashBytes((const unsigned char*)stamp, sizeof(stamp)) | 1;
+}
+
+// Écrit dans un fichier temporaire puis le renomme : une entrée à moitié
+// écrite (jeu coupé, disque plein) n'est jamais prise pour une entrée valide.
+void WriteDecodedCache(const char* cachePath, Image image, uint64_t sourceKey)
+{
+#if defined(_WIN32)
+    _mkdir(DECODED_CACHE_DIR);
+#else
+    mkdir(DECODED_CACHE_DIR, 0755);
+#endif
+    char tempPath[96];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", cachePath);
+    FILE* f = fopen(tempPath, "wb");
+    if (!f) return;
+
+    DecodedHeader header = {{'G', 'T', 'X', '2'}, (uint32_t)image.width, (uint32_t)image.height,
+                            (uint32_t)image.format, (uint32_t)GetPixelDataSize(image.width, image.height, image.format),
+                            0, sourceKey};
+    bool written = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                   fwrite(image.data, 1, header.dataSize, f) == header.dataSize;
+    written = fclose(f) == 0 && written;
+#if defined(_WIN32)
+    if (written) remove(cachePath); // rename ne remplace pas un fichier sous Windows
+#endif
+    if (!written || rename(tempPath, cachePath) != 0) remove(tempPath);
+}
+
+Texture2D LoadTextureCached(const char* path)
+{
+    uint64_t sourceKey = DecodedSourceKey(path);
+    if (sourceKey == 0) return Texture2D{};
+
+    char cachePath[64];
+    snprintf(cachePath, sizeof(cachePath), DECODED_CACHE_DIR "/%016llx.tex",
+             (unsigned long long)HashBytes((const unsigned char*)path, strlen(path)));
+    MappedFile mapping;
+    if (mapping.Open(cachePath))
+    {
+        DecodedHeader header;
+        bool valid = mapping.size >= sizeof(header);
+        if (valid)
+        {
+            memcpy(&header, mapping.data, sizeof(header));
+            valid = memcmp(header.magic, "GTX2", 4) == 0 && header.sourceKey == sourceKey &&
+                    mapping.size >= sizeof(header) + header.dataSize;
+        }
+        if (valid)
+        {
+            Image image = {(void*)(mapping.data + sizeof(header)), (int)header.width, (int)header.height, 1,
+                           (int)header.format};
+            Texture2D texture = LoadTextureFromImage(image);
+            mapping.Close();
+            return texture;
+        }
+        mapping.Close();
+    }
+
+    // Entrée absente ou périmée : on décode la source et on réécrit l'entrée
+    int sourceSize = 0;
+    const unsigned char* packed = assetPack.Find(path, &sourceSize);
+    unsigned char* loose = packed ? nullptr : LoadFileData(path, &sourceSize);
+    const unsigned char* source = packed ? packed : loose;
+    if (!source) return Texture2D{};
+    Image image = LoadImageFromMemory(GetFileExtension(path), source, sourceSize);
+    if (loose) UnloadFileData(loose);
+    if (!image.data) return Texture2D{};
+    WriteDecodedCache(cachePath, image, sourceKey);
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    return texture;
+}
+
 struct AnimData
 {
     Rectangle rec;
     Vector2 pos;
+    Vector2 lastPos; // position au pas de simulation précédent
     int frame;
     float updateTime;
     float runningTime;
@@ -20,6 +353,379 @@ struct HighScore
     char date[20];
 };
 
+// Fond statique pré-composé une seule fois dans une render texture de la
+// taille de l'écran : chaque frame le copie sans mise à l'échelle, et la
+// texture source (plus grande que l'écran) est libérée tout de suite.
+RenderTexture2D LoadStaticLayer(const char* path, int width, int height)
+{
+    Texture2D source = LoadTextureCached(path);
+    RenderTexture2D layer = LoadRenderTexture(width, height);
+    BeginTextureMode(layer);
+    ClearBackground(BLANK);
+    DrawTexture(source, 0, 0, WHITE);
+    EndTextureMode();
+    UnloadTexture(source);
+    return layer;
+}
+
+void DrawStaticLayer(RenderTexture2D layer)
+{
+    // Les render textures sont stockées à l'envers
+    DrawTextureRec(layer.texture, {0, 0, (float)layer.texture.width, -(float)layer.texture.height}, {0, 0}, WHITE);
+}
+
+// Texte mis en cache dans une render texture : dessiné une seule fois en
+// blanc, puis copié en un seul quad (au lieu d'un quad par lettre) et teinté
+// à la copie. Il n'est redessiné que si la chaîne change.
+struct CachedText
+{
+    RenderTexture2D target{};
+    char text[128] = "";
+    int fontSize = 0;
+    int width = 0;
+};
+
+void DrawCachedText(CachedText& cache, const char* text, int x, int y, int fontSize, Color color)
+{
+    if (fontSize != cache.fontSize || strcmp(text, cache.text) != 0)
+    {
+        snprintf(cache.text, sizeof(cache.text), "%s", text);
+        cache.fontSize = fontSize;
+        cache.width = MeasureText(cache.text, fontSize);
+        if (cache.width == 0) return;
+        if (cache.target.id == 0 || cache.width > cache.target.texture.width || fontSize != cache.target.texture.height)
+        {
+            if (cache.target.id != 0) UnloadRenderTexture(cache.target);
+            cache.target = LoadRenderTexture(cache.width + 64, fontSize); // marge pour les chiffres en plus
+        }
+        BeginTextureMode(cache.target);
+        ClearBackground(BLANK);
+        DrawText(cache.text, 0, 0, fontSize, WHITE);
+        EndTextureMode();
+    }
+    if (cache.width == 0) return;
+    DrawTextureRec(cache.target.texture, {0, 0, (float)cache.width, -(float)fontSize}, {(float)x, (float)y}, color);
+}
+
+void UnloadCachedText(CachedText& cache)
+{
+    if (cache.target.id != 0) UnloadRenderTexture(cache.target);
+    cache = CachedText();
+}
+
+// Pas de simulation fixe (120 Hz), indépendant de la fréquence d'affichage.
+// Le dessin interpole entre les deux derniers pas.
+const float SIM_DT = 1.0f / 120.0f;
+const int MAX_SIM_STEPS = 8; // au-delà, le retard est abandonné
+
+// Position à dessiner ; pas d'interpolation après un saut de position
+// (obstacle replacé à droite de l'écran)
+Vector2 InterpolatePos(AnimData data, float alpha)
+{
+    if (fabsf(data.pos.x - data.lastPos.x) > 200 || fabsf(data.pos.y - data.lastPos.y) > 200) return data.pos;
+    return { data.lastPos.x + (data.pos.x - data.lastPos.x) * alpha,
+             data.lastPos.y + (data.pos.y - data.lastPos.y) * alpha };
+}
+
+// Arène de frame : les chaînes du HUD sont écrites dans un bloc fixe remis
+// à zéro après chaque BeginDrawing, au lieu du tampon tournant de TextFormat.
+// Le pic d'utilisation (highWater) sert à dimensionner le bloc.
+const int FRAME_ARENA_BYTES = 4096;
+
+struct FrameArena
+{
+    char data[FRAME_ARENA_BYTES];
+    int used = 0;
+    int highWater = 0;
+    int overflows = 0;
+
+    void Reset()
+    {
+        used = 0;
+    }
+
+    // printf dans l'arène ; chaîne vide si le bloc est plein
+    const char* Format(const char* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(data + used, FRAME_ARENA_BYTES - used, format, args);
+        va_end(args);
+        if (length < 0 || used + length + 1 > FRAME_ARENA_BYTES)
+        {
+            overflows++;
+            return "";
+        }
+        const char* text = data + used;
+        used += length + 1;
+        highWater = std::max(highWater, used);
+        return text;
+    }
+};
+
+FrameArena frameArena;
+
+// Enregistrement et relecture : "jeu --record fichier" enregistre la session,
+// "jeu --replay fichier" la rejoue à l'identique. Le fichier contient la
+// graine de GetRandomValue puis, pour chaque frame, sa durée et les touches
+// lues par le jeu. Les deux côtés affichent une somme de contrôle de l'état
+// final pour vérifier que la relecture est exacte.
+struct ReplayHeader
+{
+    char magic[4]; // "RRP1"
+    uint32_t frameCount;
+    uint32_t seed;
+    uint32_t reserved;
+};
+
+struct ReplayFrame
+{
+    float dt;
+    uint16_t pressed; // bit i : REPLAY_KEYS[i] appuyée pendant la frame
+    uint16_t reserved;
+};
+
+// Toutes les touches lues avec IsKeyPressed, plus le clic gauche (dernier bit)
+const int REPLAY_KEYS[] = {KEY_ENTER, KEY_UP, KEY_DOWN, KEY_SPACE, KEY_W, KEY_A, KEY_ESCAPE};
+const int REPLAY_KEY_COUNT = sizeof(REPLAY_KEYS) / sizeof(REPLAY_KEYS[0]);
+const uint16_t REPLAY_MOUSE_BIT = 1 << REPLAY_KEY_COUNT;
+
+enum ReplayMode { REPLAY_OFF, REPLAY_RECORD, REPLAY_PLAY };
+
+struct Replay
+{
+    ReplayMode mode = REPLAY_OFF;
+    ReplayHeader header = {{'R', 'R', 'P', '1'}, 0, 0, 0};
+    std::vector<ReplayFrame> frames;
+    size_t cursor = 0;
+    ReplayFrame current = {};
+};
+
+Replay replay;
+
+bool LoadReplay(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    bool ok = fread(&replay.header, sizeof(ReplayHeader), 1, file) == 1 && memcmp(replay.header.magic, "RRP1", 4) == 0;
+    if (ok)
+    {
+        replay.frames.resize(replay.header.frameCount);
+        ok = replay.frames.empty() || fread(replay.frames.data(), sizeof(ReplayFrame), replay.frames.size(), file) == replay.frames.size();
+    }
+    fclose(file);
+    return ok;
+}
+
+bool SaveReplay(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    replay.header.frameCount = replay.frames.size();
+    bool ok = fwrite(&replay.header, sizeof(ReplayHeader), 1, file) == 1;
+    if (ok && !replay.frames.empty()) ok = fwrite(replay.frames.data(), sizeof(ReplayFrame), replay.frames.size(), file) == replay.frames.size();
+    fclose(file);
+    return ok;
+}
+
+// À appeler au début de chaque frame : renvoie la durée de frame à utiliser
+float BeginReplayFrame(float dt)
+{
+    if (replay.mode == REPLAY_RECORD)
+    {
+        replay.current = {dt, 0, 0};
+        for (int i = 0; i < REPLAY_KEY_COUNT; i++)
+        {
+            if (IsKeyPressed(REPLAY_KEYS[i])) replay.current.pressed |= 1 << i;
+        }
+        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) replay.current.pressed |= REPLAY_MOUSE_BIT;
+        replay.frames.push_back(replay.current);
+    }
+    else if (replay.mode == REPLAY_PLAY)
+    {
+        replay.current = replay.cursor < replay.frames.size() ? replay.frames[replay.cursor++] : ReplayFrame{0.0f, 0, 0};
+        return replay.current.dt;
+    }
+    return dt;
+}
+
+bool ReplayFinished()
+{
+    return replay.mode == REPLAY_PLAY && replay.cursor >= replay.frames.size();
+}
+
+// IsKeyPressed / IsMouseButtonPressed, lus depuis la frame en cours
+bool KeyPressed(int key)
+{
+    if (replay.mode == REPLAY_OFF) return IsKeyPressed(key);
+    for (int i = 0; i < REPLAY_KEY_COUNT; i++)
+    {
+        if (REPLAY_KEYS[i] == key) return (replay.current.pressed & (1 << i)) != 0;
+    }
+    return false;
+}
+
+bool MouseLeftPressed()
+{
+    if (replay.mode == REPLAY_OFF) return IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    return (replay.current.pressed & REPLAY_MOUSE_BIT) != 0;
+}
+
+// Enregistreur de saccades : les HITCH_HISTORY dernières frames (durées de
+// mise à jour et de dessin, état, score, vitesse) restent en mémoire. Une
+// frame plus de deux fois plus longue que la cible écrit cet historique dans
+// hitch_<date>_<heure>_f<frame>.csv, HITCH_FRAMES_AFTER frames plus tard pour
+// voir aussi la suite.
+const int HITCH_HISTORY = 600;
+const int HITCH_FRAMES_AFTER = 60;
+const int TARGET_FPS = 60;
+
+struct HitchFrame
+{
+    float frameMs;
+    float updateMs;
+    float drawMs;
+    int state;
+    int score;
+    float gameSpeed;
+    bool hitch;
+};
+
+struct HitchRecorder
+{
+    HitchFrame frames[HITCH_HISTORY];
+    int head = 0;
+    int count = 0;
+    long long frameNumber = 0;
+    int dumpIn = -1; // frames avant l'écriture, -1 : rien en attente
+};
+
+HitchRecorder hitchRecorder;
+
+bool WriteHitchRecord()
+{
+    HitchRecorder& r = hitchRecorder;
+    r.dumpIn = -1;
+    char date[32], fileName[64];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y%m%d_%H%M%S", localtime(&now));
+    snprintf(fileName, sizeof(fileName), "hitch_%s_f%lld.csv", date, r.frameNumber);
+    FILE* file = fopen(fileName, "w");
+    if (!file) return false;
+    
+    fprintf(file, "FRAME,HITCH,FRAME MS,UPDATE MS,DRAW MS,STATE,SCORE,GAME SPEED\n");
+    int hitches = 0;
+    for (int i = 0; i < r.count; i++)
+    {
+        const HitchFrame& f = r.frames[(r.head - r.count + i + HITCH_HISTORY) % HITCH_HISTORY];
+        hitches += f.hitch;
+        fprintf(file, "%lld,%d,%.3f,%.3f,%.3f,%d,%d,%.1f\n", r.frameNumber - r.count + i, (int)f.hitch,
+                f.frameMs, f.updateMs, f.drawMs, f.state, f.score, f.gameSpeed);
+    }
+    fclose(file);
+    TraceLog(LOG_WARNING, "SACCADE : %d frame(s) au-delà de %.1f ms, historique écrit dans %s",
+             hitches, 2000.0f / TARGET_FPS, fileName);
+    return true;
+}
+
+void RecordHitchFrame(HitchFrame frame)
+{
+    HitchRecorder& r = hitchRecorder;
+    frame.hitch = frame.frameMs > 2000.0f / TARGET_FPS;
+    r.frames[r.head] = frame;
+    r.head = (r.head + 1) % HITCH_HISTORY;
+    r.count = std::min(r.count + 1, HITCH_HISTORY);
+    r.frameNumber++;
+    
+    if (frame.hitch && r.dumpIn < 0) r.dumpIn = HITCH_FRAMES_AFTER;
+    else if (r.dumpIn > 0) r.dumpIn--;
+    if (r.dumpIn == 0) WriteHitchRecord();
+}
+
+// Limiteur de frames, à la place de SetTargetFPS : on dort par pas de 1 ms
+// tant que le pas le plus lent attendu (moyenne + 2 écarts-types des pas
+// mesurés) se termine avant l'échéance, puis on boucle activement jusqu'à
+// elle, car un sommeil du système peut déborder d'un tick d'ordonnanceur.
+// Appelé juste avant EndDrawing, pour que les images partent à intervalles
+// réguliers. Les intervalles entre images donnent la gigue (écart-type,
+// p99), affichée à la fermeture.
+const int INTERVAL_HISTORY = 600;
+
+struct FrameLimiter
+{
+    double period = 1.0 / TARGET_FPS;
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::steady_clock::time_point lastFrame;
+    bool started = false;
+    long long sleepSteps = 0;
+    double sleepMean = 0.001;
+    double sleepM2 = 0.0;
+    float intervals[INTERVAL_HISTORY] = {}; // ms
+    int intervalHead = 0;
+    int intervalCount = 0;
+    int late = 0; // images parties plus d'un dixième de période après l'échéance
+};
+
+FrameLimiter frameLimiter;
+
+void WaitForFrameDeadline()
+{
+    typedef std::chrono::steady_clock Clock;
+    FrameLimiter& l = frameLimiter;
+    Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(l.period));
+    if (l.started)
+    {
+        for (;;)
+        {
+            double remaining = std::chrono::duration<double>(l.deadline - Clock::now()).count();
+            double stddev = l.sleepSteps > 1 ? sqrt(l.sleepM2 / (l.sleepSteps - 1)) : 0.0;
+            if (remaining <= l.sleepMean + 2.0 * stddev) break;
+            
+            Clock::time_point start = Clock::now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            double slept = std::chrono::duration<double>(Clock::now() - start).count();
+            l.sleepSteps++;
+            double delta = slept - l.sleepMean;
+            l.sleepMean += delta / l.sleepSteps;
+            l.sleepM2 += delta * (slept - l.sleepMean);
+        }
+        while (Clock::now() < l.deadline) {}
+    }
+    
+    Clock::time_point now = Clock::now();
+    if (l.started)
+    {
+        l.intervals[l.intervalHead] = std::chrono::duration<float, std::milli>(now - l.lastFrame).count();
+        l.intervalHead = (l.intervalHead + 1) % INTERVAL_HISTORY;
+        l.intervalCount = std::min(l.intervalCount + 1, INTERVAL_HISTORY);
+        if (now > l.deadline + period / 10) l.late++;
+        l.deadline += period;
+        // Trop en retard pour rattraper : l'échéancier repart de maintenant
+        if (l.deadline < now) l.deadline = now + period;
+    }
+    else
+    {
+        l.deadline = now + period;
+    }
+    l.lastFrame = now;
+    l.started = true;
+}
+
+void LogFrameJitter()
+{
+    FrameLimiter& l = frameLimiter;
+    if (l.intervalCount == 0) return;
+    std::vector<float> sorted(l.intervals, l.intervals + l.intervalCount);
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0, squares = 0.0;
+    for (float interval : sorted) sum += interval;
+    double average = sum / l.intervalCount;
+    for (float interval : sorted) squares += (interval - average) * (interval - average);
+    TraceLog(LOG_INFO, "LIMITEUR : %d derniers intervalles, moyenne %.2f ms, écart-type %.2f ms, p99 %.2f ms, %d en retard",
+             l.intervalCount, average, sqrt(squares / l.intervalCount),
+             sorted[std::min(l.intervalCount - 1, l.intervalCount * 99 / 100)], l.late);
+}
+
 bool isOnGround(AnimData data, int windowHeight)
 {
    return data.pos.y >= (windowHeight - 80) - data.rec.height;
@@ -102,40 +808,139 @@ void AddHighScore(std::vector<HighScore>& scores, int newScore)
     SaveHighScores(scores);
 }
 
-int main()
+// Microbenchmarks : "jeu --bench [fichier.json]" (ou "make bench") mesure
+// le coût par appel de updateAnimData, sur une animation (cas réel) et sur
+// 10000 (cas de charge). Tableau à l'écran et JSON au format Google Benchmark.
+struct BenchResult
+{
+    const char* name;
+    long long iterations;
+    double nsPerOp;
+    long long items;
+};
+
+// Double le nombre d'itérations jusqu'à ce qu'une mesure dure 0,2 s
+BenchResult BenchAnimData(const char* name, int count)
+{
+    std::vector<AnimData> anims(count);
+    for (int i = 0; i < count; i++)
+    {
+        anims[i] = {};
+        anims[i].rec = {0, 0, 64, 64};
+        anims[i].updateTime = 1.0f / (10 + i % 7);
+    }
+    for (long long iterations = 1;; iterations *= 2)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < iterations; i++)
+        {
+            for (AnimData& a : anims) a = updateAnimData(a, SIM_DT, 7);
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (ns >= 2.0e8)
+        {
+            printf("%-32s %14.1f ns/op %12lld itérations\n", name, ns / iterations, iterations);
+            return {name, iterations, ns / iterations, count};
+        }
+    }
+}
+
+int RunMicroBenchmarks(const char* jsonFile)
 {
+    BenchResult results[] = {BenchAnimData("updateAnimData/realistic", 1),
+                             BenchAnimData("updateAnimData/stress", 10000)};
+    const int count = sizeof(results) / sizeof(results[0]);
+    
+    FILE* f = fopen(jsonFile, "w");
+    if (!f)
+    {
+        printf("bench : impossible d'écrire %s\n", jsonFile);
+        return 1;
+    }
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    fprintf(f, "{\n  \"context\": {\"date\": \"%s\", \"executable\": \"ZORO RUNNER\", \"num_cpus\": %u},\n",
+            date, std::thread::hardware_concurrency());
+    fprintf(f, "  \"benchmarks\": [\n");
+    for (int i = 0; i < count; i++)
+    {
+        fprintf(f, "    {\"name\": \"%s\", \"iterations\": %lld, \"real_time\": %.3f, \"time_unit\": \"ns\", "
+                "\"items_per_iteration\": %lld}%s\n",
+                results[i].name, results[i].iterations, results[i].nsPerOp, results[i].items, i + 1 < count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    printf("bench : résultats écrits dans %s\n", jsonFile);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        return RunMicroBenchmarks(argc > 2 ? argv[2] : "bench.json");
+    }
+    
+    // Enregistrement ou relecture d'une session
+    const char* replayPath = argc > 2 ? argv[2] : nullptr;
+    if (replayPath && strcmp(argv[1], "--record") == 0)
+    {
+        replay.mode = REPLAY_RECORD;
+        replay.header.seed = (uint32_t)time(nullptr);
+    }
+    else if (replayPath && strcmp(argv[1], "--replay") == 0)
+    {
+        if (!LoadReplay(replayPath))
+        {
+            printf("replay : impossible de lire %s\n", replayPath);
+            return 1;
+        }
+        replay.mode = REPLAY_PLAY;
+    }
+    
     // Dimensions de la fenêtre
     const int windowWidth = 1280;
     const int windowHeight = 720;
 
     InitWindow(windowWidth, windowHeight, "ZORO RUNNER");
+    
+    // Après InitWindow, qui réinitialise la graine
+    if (replay.mode != REPLAY_OFF) SetRandomSeed(replay.header.seed);
        
+    // Assets : un seul pack mappé, fichiers séparés s'il est absent
+    assetPack.Open("assets.pak");
+
     // Sons
     InitAudioDevice();
-    Sound jumpSound = LoadSound("Sounds/jump.wav");
-    Sound collectSound = LoadSound("Sounds/pickupCoin.wav");
-    Sound hitSound = LoadSound("Sounds/hitHurt.wav");
-    Sound slashSound = LoadSound("Sounds/slash.wav"); // Son du slash
-    Music bgMusic = LoadMusicStream("Sounds/Pixel Kings.wav");
+    Sound jumpSound = LoadSoundAsset("Sounds/jump.wav");
+    Sound collectSound = LoadSoundAsset("Sounds/pickupCoin.wav");
+    Sound hitSound = LoadSoundAsset("Sounds/hitHurt.wav");
+    Sound slashSound = LoadSoundAsset("Sounds/slash.wav"); // Son du slash
+    Music bgMusic = LoadMusicAsset("Sounds/Pixel Kings.wav");
 
     // Background - un seul pour chaque écran
-    Texture2D bgIntro = LoadTexture("textures/intro_bg.jpg"); // Background pour l'intro
-    Texture2D bgGame = LoadTexture("textures/game_bg.jpg");   // Background pour le jeu
+    RenderTexture2D bgIntro = LoadStaticLayer("textures/intro_bg.jpg", windowWidth, windowHeight); // Background pour l'intro
+    RenderTexture2D bgGame = LoadStaticLayer("textures/game_bg.jpg", windowWidth, windowHeight);   // Background pour le jeu
+    
+    // Textes du HUD et des instructions, redessinés seulement s'ils changent
+    CachedText hudScore, hudSpeed;
+    CachedText menuHelp[3], playHelp[3];
     
     // Zoro textures
-    Texture2D zoroWalk = LoadTexture("textures/zoro_assets/Walk.png");
-    Texture2D zoroJump = LoadTexture("textures/zoro_assets/Jump.png");
-    Texture2D zoroIdle = LoadTexture("textures/zoro_assets/IDLE.png");
-    Texture2D zoroVictory = LoadTexture("textures/zoro_assets/Victory.png");
-    Texture2D zoroSlash = LoadTexture("textures/zoro_assets/Slash.png"); // Animation de slash
+    Texture2D zoroWalk = LoadTextureCached("textures/zoro_assets/Walk.png");
+    Texture2D zoroJump = LoadTextureCached("textures/zoro_assets/Jump.png");
+    Texture2D zoroIdle = LoadTextureCached("textures/zoro_assets/IDLE.png");
+    Texture2D zoroVictory = LoadTextureCached("textures/zoro_assets/Victory.png");
+    Texture2D zoroSlash = LoadTextureCached("textures/zoro_assets/Slash.png"); // Animation de slash
     
     // Obstacles - style japonais
-    Texture2D kunai = LoadTexture("textures/kunai.png");        // Projectile bas
-    Texture2D shuriken = LoadTexture("textures/shuriken.png");  // Projectile haut
+    Texture2D kunai = LoadTextureCached("textures/kunai.png");        // Projectile bas
+    Texture2D shuriken = LoadTextureCached("textures/shuriken.png");  // Projectile haut
     
     // Items
-    Texture2D sake = LoadTexture("textures/sake.png");          // Remplace le melon
-    Texture2D coin = LoadTexture("textures/coin.png");          // Pièces bonus
+    Texture2D sake = LoadTextureCached("textures/sake.png");          // Remplace le melon
+    Texture2D coin = LoadTextureCached("textures/coin.png");          // Pièces bonus
     
     // Données d'animation pour Zoro
     AnimData zoroData;
@@ -215,7 +1020,7 @@ int main()
     
     // Variables du jeu
     bool isJumping = false;
-    int zoroVelocity = 0;
+    float zoroVelocity = 0.0f;
     const int jumpForce = 800;
     const int gravity = 2000;
     float gameSpeed = 300.0f;
@@ -244,11 +1049,49 @@ int main()
     introZoroData.runningTime = 0;
     introZoroData.updateTime = 0.15f;
     
-    SetTargetFPS(60);
+    // Boucle à pas fixe
+    float simAccumulator = 0.0f;
+    float simAlpha = 0.0f;
+    bool jumpPressed = false;   // appuis gardés jusqu'au prochain pas
+    bool attackPressed = false;
+    
+    // Pas de SetTargetFPS : WaitForFrameDeadline cadence les images
+    
+    // Chronométrage pour l'enregistreur de saccades
+    using Clock = std::chrono::steady_clock;
+    auto msSince = [](Clock::time_point start) { return std::chrono::duration<float, std::milli>(Clock::now() - start).count(); };
+    Clock::time_point frameStart = Clock::now();
+    
+    // Somme de contrôle de l'état de jeu, comparée entre enregistrement et relecture
+    auto stateChecksum = [&]()
+    {
+        uint64_t hash = HashBytes((const unsigned char*)&score, sizeof(score));
+        hash = HashBytes((const unsigned char*)&gameSpeed, sizeof(gameSpeed), hash);
+        hash = HashBytes((const unsigned char*)&zoroData.pos, sizeof(zoroData.pos), hash);
+        for (int i = 0; i < NumOfKunais; i++) hash = HashBytes((const unsigned char*)&kunais[i].pos, sizeof(Vector2), hash);
+        for (int i = 0; i < NumOfShurikens; i++) hash = HashBytes((const unsigned char*)&shurikens[i].pos, sizeof(Vector2), hash);
+        for (int i = 0; i < NumOfItems; i++) hash = HashBytes((const unsigned char*)&items[i].pos, sizeof(Vector2), hash);
+        return hash;
+    };
+    
+    // Fin d'enregistrement ou de relecture, à chaque sortie de la boucle
+    auto endReplay = [&]()
+    {
+        if (replay.mode == REPLAY_RECORD)
+        {
+            if (!SaveReplay(replayPath)) printf("replay : impossible d'écrire %s\n", replayPath);
+        }
+        if (replay.mode != REPLAY_OFF)
+        {
+            printf("replay : %d frames, score %d, somme de contrôle %016llx\n",
+                   (int)replay.frames.size(), score, (unsigned long long)stateChecksum());
+        }
+    };
     
-    while (!WindowShouldClose())
+    while (!WindowShouldClose() && !ReplayFinished())
     {
-        float dt = GetFrameTime();
+        float dt = BeginReplayFrame(GetFrameTime());
+        Clock::time_point updateStart = Clock::now();
         
         switch (currentState)
         {
@@ -265,7 +1108,7 @@ int main()
                 }
                 
                 // Après 4 secondes ou si on appuie sur ENTER, aller au menu
-                if (introTimer > 4.0f || IsKeyPressed(KEY_ENTER))
+                if (introTimer > 4.0f || KeyPressed(KEY_ENTER))
                 {
                     currentState = STATE_MENU;
                     if (musicOn) PlayMusicStream(bgMusic);
@@ -278,10 +1121,10 @@ int main()
                 UpdateMusicStream(bgMusic);
                 
                 // Navigation du menu
-                if (IsKeyPressed(KEY_DOWN)) menuSelection = (menuSelection + 1) % 4;
-                if (IsKeyPressed(KEY_UP)) menuSelection = (menuSelection + 3) % 4;
+                if (KeyPressed(KEY_DOWN)) menuSelection = (menuSelection + 1) % 4;
+                if (KeyPressed(KEY_UP)) menuSelection = (menuSelection + 3) % 4;
                 
-                if (IsKeyPressed(KEY_ENTER))
+                if (KeyPressed(KEY_ENTER))
                 {
                     switch (menuSelection)
                     {
@@ -291,7 +1134,12 @@ int main()
                             collision = false;
                             zoroData.pos.y = (windowHeight - 80) - zoroData.rec.height;
                             isJumping = false;
-                            zoroVelocity = 0;
+                            zoroVelocity = 0.0f;
+                            zoroData.lastPos = zoroData.pos;
+                            simAccumulator = 0.0f;
+                            simAlpha = 0.0f;
+                            jumpPressed = false;
+                            attackPressed = false;
                             isAttacking = false;
                             attackCooldown = 0.0f;
                             
@@ -300,6 +1148,7 @@ int main()
                             for (int i = 0; i < NumOfKunais; i++)
                             {
                                 kunais[i].pos.x = windowWidth + kunaiDist;
+                                kunais[i].lastPos = kunais[i].pos;
                                 kunais[i].frame = 0;
                                 kunaiDist += 10000;
                             }
@@ -308,6 +1157,7 @@ int main()
                             for (int i = 0; i < NumOfShurikens; i++)
                             {
                                 shurikens[i].pos.x = windowWidth + shurikenDist;
+                                shurikens[i].lastPos = shurikens[i].pos;
                                 shurikens[i].frame = 0;
                                 shurikenDist += 15000;
                             }
@@ -316,6 +1166,7 @@ int main()
                             for (int i = 0; i < NumOfItems; i++)
                             {
                                 items[i].pos.x = windowWidth + itemDist;
+                                items[i].lastPos = items[i].pos;
                                 itemDist += 15000;
                             }
                             
@@ -333,6 +1184,11 @@ int main()
                             break;
                             
                         case 3: // Quitter
+                            if (hitchRecorder.dumpIn >= 0) WriteHitchRecord();
+                            endReplay();
+                            LogFrameJitter();
+                            TraceLog(LOG_INFO, "ARENE DE FRAME : pic %d / %d octets, %d débordement(s)",
+                                     frameArena.highWater, FRAME_ARENA_BYTES, frameArena.overflows);
                             CloseWindow();
                             return 0;
                     }
@@ -346,188 +1202,209 @@ int main()
                 {
                     UpdateMusicStream(bgMusic);
                     
-                    // Gestion du cooldown de l'attaque
-                    if (attackCooldown > 0)
-                    {
-                        attackCooldown -= dt;
-                    }
-                    
-                    // Contrôles
-                    if ((IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_W)) && !isJumping)
-                    {
-                        zoroVelocity = -jumpForce;
-                        isJumping = true;
-                        PlaySound(jumpSound);
-                    }
-                    
-                    // Attaque avec la touche A ou clic gauche
-                    if ((IsKeyPressed(KEY_A) || IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) && !isAttacking && attackCooldown <= 0)
-                    {
-                        isAttacking = true;
-                        slashData.frame = 0;
-                        slashData.runningTime = 0;
-                        slashData.pos.x = zoroData.pos.x + zoroData.rec.width - 50;
-                        slashData.pos.y = zoroData.pos.y;
-                        PlaySound(slashSound);
-                    }
+                    if (KeyPressed(KEY_SPACE) || KeyPressed(KEY_W)) jumpPressed = true;
+                    if (KeyPressed(KEY_A) || MouseLeftPressed()) attackPressed = true;
                     
-                    // Mise à jour de l'animation d'attaque
-                    if (isAttacking)
+                    simAccumulator += dt;
+                    int steps = 0;
+                    while (simAccumulator >= SIM_DT && !collision)
                     {
-                        slashData = updateAnimData(slashData, dt, 5); // 6 frames (0-5)
-                        
-                        // Fin de l'animation d'attaque
-                        if (slashData.frame == 0 && slashData.runningTime == 0)
+                        if (steps == MAX_SIM_STEPS)
                         {
-                            isAttacking = false;
-                            attackCooldown = attackCooldownTime;
+                            simAccumulator = 0.0f;
+                            break;
                         }
-                    }
-                    
-                    // Physique du saut
-                    if (isJumping)
-                    {
-                        zoroVelocity += gravity * dt;
-                        zoroData.pos.y += zoroVelocity * dt;
                         
-                        if (zoroData.pos.y >= (windowHeight - 80) - zoroData.rec.height)
+                        // Pas fixe : dt masque la durée de la frame
+                        float dt = SIM_DT;
+                        zoroData.lastPos = zoroData.pos;
+                        for (int i = 0; i < NumOfKunais; i++) kunais[i].lastPos = kunais[i].pos;
+                        for (int i = 0; i < NumOfShurikens; i++) shurikens[i].lastPos = shurikens[i].pos;
+                        for (int i = 0; i < NumOfItems; i++) items[i].lastPos = items[i].pos;
+                        
+                        // Gestion du cooldown de l'attaque
+                        if (attackCooldown > 0)
                         {
-                            zoroData.pos.y = (windowHeight - 80) - zoroData.rec.height;
-                            isJumping = false;
-                            zoroVelocity = 0;
+                            attackCooldown -= dt;
                         }
-                    }
                     
-                    // Mise à jour du score
-                    scoreTimer += dt;
-                    if (scoreTimer >= 1.0f)
-                    {
-                        scoreTimer = 0.0f;
-                        score += 10;
-                        
-                        // Augmenter la difficulté
-                        if (gameSpeed < 700.0f)
+                        // Contrôles
+                        if (jumpPressed && !isJumping)
                         {
-                            gameSpeed += 5.0f;
+                            zoroVelocity = -jumpForce;
+                            isJumping = true;
+                            PlaySound(jumpSound);
                         }
-                    }
-                    
-                    // Animation de Zoro
-                    if (isJumping)
-                    {
-                        // Utiliser l'animation de saut
-                        zoroData = updateAnimData(zoroData, dt, 6);
-                    }
-                    else if (isAttacking)
-                    {
-                        // Animation d'attaque (frame fixe ou spéciale)
-                        zoroData.frame = 0; // Frame d'attente
-                    }
-                    else
-                    {
-                        // Animation de marche
-                        zoroData = updateAnimData(zoroData, dt, 7);
-                    }
                     
-                    // Mise à jour des obstacles
-                    for (int i = 0; i < NumOfKunais; i++)
-                    {
-                        kunais[i] = updateAnimData(kunais[i], dt, 3);
-                        kunais[i].pos.x -= gameSpeed * dt;
-                        
-                        if (kunais[i].pos.x <= -200)
+                        // Attaque avec la touche A ou clic gauche
+                        if (attackPressed && !isAttacking && attackCooldown <= 0)
                         {
-                            kunais[i].pos.x = windowWidth + GetRandomValue(1000, 5000);
+                            isAttacking = true;
+                            slashData.frame = 0;
+                            slashData.runningTime = 0;
+                            slashData.pos.x = zoroData.pos.x + zoroData.rec.width - 50;
+                            slashData.pos.y = zoroData.pos.y;
+                            PlaySound(slashSound);
                         }
+                    
+                        // Mise à jour de l'animation d'attaque
+                        if (isAttacking)
+                        {
+                            slashData = updateAnimData(slashData, dt, 5); // 6 frames (0-5)
                         
-                        // Collision avec les kunais (bas)
-                        Rectangle kunaiRect = { kunais[i].pos.x + 10, kunais[i].pos.y + 10, 
-                                               kunais[i].rec.width - 20, kunais[i].rec.height - 20 };
-                        Rectangle zoroRect = { zoroData.pos.x + 20, zoroData.pos.y + 20, 
-                                              zoroData.rec.width - 40, zoroData.rec.height - 40 };
+                            // Fin de l'animation d'attaque
+                            if (slashData.frame == 0 && slashData.runningTime == 0)
+                            {
+                                isAttacking = false;
+                                attackCooldown = attackCooldownTime;
+                            }
+                        }
+                    
+                        // Physique du saut
+                        if (isJumping)
+                        {
+                            zoroVelocity += gravity * dt;
+                            zoroData.pos.y += zoroVelocity * dt;
                         
-                        // Hitbox du slash pour détruire les projectiles
-                        Rectangle slashRect = { slashData.pos.x, slashData.pos.y + 20,
-                                              slashData.rec.width - 20, slashData.rec.height - 40 };
+                            if (zoroData.pos.y >= (windowHeight - 80) - zoroData.rec.height)
+                            {
+                                zoroData.pos.y = (windowHeight - 80) - zoroData.rec.height;
+                                isJumping = false;
+                                zoroVelocity = 0;
+                            }
+                        }
+                    
+                        // Mise à jour du score
+                        scoreTimer += dt;
+                        if (scoreTimer >= 1.0f)
+                        {
+                            scoreTimer = 0.0f;
+                            score += 10;
                         
-                        // Vérifier si le kunai est détruit par le slash
-                        if (isAttacking && CheckCollisionRecs(slashRect, kunaiRect))
+                            // Augmenter la difficulté
+                            if (gameSpeed < 700.0f)
+                            {
+                                gameSpeed += 5.0f;
+                            }
+                        }
+                    
+                        // Animation de Zoro
+                        if (isJumping)
                         {
-                            PlaySound(collectSound); // Son de destruction
-                            score += 50; // Points bonus pour la destruction
-                            kunais[i].pos.x = windowWidth + GetRandomValue(1000, 5000);
+                            // Utiliser l'animation de saut
+                            zoroData = updateAnimData(zoroData, dt, 6);
                         }
-                        // Sinon, vérifier la collision avec Zoro
-                        else if (CheckCollisionRecs(kunaiRect, zoroRect) && !isJumping)
+                        else if (isAttacking)
                         {
-                            collision = true;
-                            PlaySound(hitSound);
-                            StopMusicStream(bgMusic);
+                            // Animation d'attaque (frame fixe ou spéciale)
+                            zoroData.frame = 0; // Frame d'attente
                         }
-                    }
-                    
-                    for (int i = 0; i < NumOfShurikens; i++)
-                    {
-                        shurikens[i] = updateAnimData(shurikens[i], dt, 3);
-                        shurikens[i].pos.x -= gameSpeed * dt;
-                        
-                        if (shurikens[i].pos.x <= -200)
+                        else
                         {
-                            shurikens[i].pos.x = windowWidth + GetRandomValue(1500, 6000);
+                            // Animation de marche
+                            zoroData = updateAnimData(zoroData, dt, 7);
                         }
-                        
-                        // Collision avec les shurikens (haut)
-                        Rectangle shurikenRect = { shurikens[i].pos.x + 10, shurikens[i].pos.y + 10, 
-                                                  shurikens[i].rec.width - 20, shurikens[i].rec.height - 20 };
+                    
+                        // Hitboxes de Zoro et du slash : calculées une fois par pas,
+                        // pas une fois par obstacle
                         Rectangle zoroRect = { zoroData.pos.x + 20, zoroData.pos.y + 20, 
                                               zoroData.rec.width - 40, zoroData.rec.height - 40 };
-                        
-                        // Hitbox du slash pour détruire les projectiles
                         Rectangle slashRect = { slashData.pos.x, slashData.pos.y + 20,
                                               slashData.rec.width - 20, slashData.rec.height - 40 };
-                        
-                        // Vérifier si le shuriken est détruit par le slash
-                        if (isAttacking && CheckCollisionRecs(slashRect, shurikenRect))
+                    
+                        // Mise à jour des obstacles
+                        for (int i = 0; i < NumOfKunais; i++)
                         {
-                            PlaySound(collectSound); // Son de destruction
-                            score += 50; // Points bonus pour la destruction
-                            shurikens[i].pos.x = windowWidth + GetRandomValue(1500, 6000);
+                            kunais[i] = updateAnimData(kunais[i], dt, 3);
+                            kunais[i].pos.x -= gameSpeed * dt;
+                        
+                            if (kunais[i].pos.x <= -200)
+                            {
+                                kunais[i].pos.x = windowWidth + GetRandomValue(1000, 5000);
+                            }
+                        
+                            // Collision avec les kunais (bas)
+                            Rectangle kunaiRect = { kunais[i].pos.x + 10, kunais[i].pos.y + 10, 
+                                                   kunais[i].rec.width - 20, kunais[i].rec.height - 20 };
+                        
+                            // Vérifier si le kunai est détruit par le slash
+                            if (isAttacking && CheckCollisionRecs(slashRect, kunaiRect))
+                            {
+                                PlaySound(collectSound); // Son de destruction
+                                score += 50; // Points bonus pour la destruction
+                                kunais[i].pos.x = windowWidth + GetRandomValue(1000, 5000);
+                            }
+                            // Sinon, vérifier la collision avec Zoro
+                            else if (CheckCollisionRecs(kunaiRect, zoroRect) && !isJumping)
+                            {
+                                collision = true;
+                                PlaySound(hitSound);
+                                StopMusicStream(bgMusic);
+                            }
                         }
-                        // Sinon, vérifier la collision avec Zoro
-                        else if (CheckCollisionRecs(shurikenRect, zoroRect) && isJumping)
+                    
+                        for (int i = 0; i < NumOfShurikens; i++)
                         {
-                            collision = true;
-                            PlaySound(hitSound);
-                            StopMusicStream(bgMusic);
+                            shurikens[i] = updateAnimData(shurikens[i], dt, 3);
+                            shurikens[i].pos.x -= gameSpeed * dt;
+                        
+                            if (shurikens[i].pos.x <= -200)
+                            {
+                                shurikens[i].pos.x = windowWidth + GetRandomValue(1500, 6000);
+                            }
+                        
+                            // Collision avec les shurikens (haut)
+                            Rectangle shurikenRect = { shurikens[i].pos.x + 10, shurikens[i].pos.y + 10, 
+                                                      shurikens[i].rec.width - 20, shurikens[i].rec.height - 20 };
+                        
+                            // Vérifier si le shuriken est détruit par le slash
+                            if (isAttacking && CheckCollisionRecs(slashRect, shurikenRect))
+                            {
+                                PlaySound(collectSound); // Son de destruction
+                                score += 50; // Points bonus pour la destruction
+                                shurikens[i].pos.x = windowWidth + GetRandomValue(1500, 6000);
+                            }
+                            // Sinon, vérifier la collision avec Zoro
+                            else if (CheckCollisionRecs(shurikenRect, zoroRect) && isJumping)
+                            {
+                                collision = true;
+                                PlaySound(hitSound);
+                                StopMusicStream(bgMusic);
+                            }
                         }
-                    }
                     
-                    // Mise à jour des items
-                    for (int i = 0; i < NumOfItems; i++)
-                    {
-                        items[i].pos.x -= gameSpeed * dt;
-                        
-                        if (items[i].pos.x <= -200)
+                        // Mise à jour des items
+                        for (int i = 0; i < NumOfItems; i++)
                         {
-                            items[i].pos.x = windowWidth + GetRandomValue(2000, 8000);
-                        }
+                            items[i].pos.x -= gameSpeed * dt;
                         
-                        // Collecter les items
-                        Rectangle itemRect = { items[i].pos.x, items[i].pos.y, 
-                                             items[i].rec.width, items[i].rec.height };
-                        Rectangle zoroRect = { zoroData.pos.x + 20, zoroData.pos.y + 20, 
-                                              zoroData.rec.width - 40, zoroData.rec.height - 40 };
+                            if (items[i].pos.x <= -200)
+                            {
+                                items[i].pos.x = windowWidth + GetRandomValue(2000, 8000);
+                            }
                         
-                        if (CheckCollisionRecs(itemRect, zoroRect))
-                        {
-                            PlaySound(collectSound);
-                            score += 100;
-                            items[i].pos.x = windowWidth + GetRandomValue(2000, 8000);
+                            // Collecter les items
+                            Rectangle itemRect = { items[i].pos.x, items[i].pos.y, 
+                                                 items[i].rec.width, items[i].rec.height };
+                        
+                            if (CheckCollisionRecs(itemRect, zoroRect))
+                            {
+                                PlaySound(collectSound);
+                                score += 100;
+                                items[i].pos.x = windowWidth + GetRandomValue(2000, 8000);
+                            }
                         }
+                    
+                        
+                        jumpPressed = false;
+                        attackPressed = false;
+                        simAccumulator -= SIM_DT;
+                        steps++;
                     }
+                    simAlpha = simAccumulator / SIM_DT;
                     
                     // Retour au menu avec ECHAP
-                    if (IsKeyPressed(KEY_ESCAPE))
+                    if (KeyPressed(KEY_ESCAPE))
                     {
                         currentState = STATE_MENU;
                     }
@@ -535,10 +1412,11 @@ int main()
                 else
                 {
                     // Écran Game Over
-                    if (IsKeyPressed(KEY_ENTER))
+                    if (KeyPressed(KEY_ENTER))
                     {
                         // Ajouter le score aux high scores si c'est un bon score
-                        if (highScores.size() < 5 || score > highScores.back().score)
+                        // Une relecture ne réenregistre pas le score
+                        if (replay.mode != REPLAY_PLAY && (highScores.size() < 5 || score > highScores.back().score))
                         {
                             AddHighScore(highScores, score);
                         }
@@ -552,7 +1430,7 @@ int main()
             
             case STATE_HIGHSCORES:
             {
-                if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_ESCAPE))
+                if (KeyPressed(KEY_ENTER) || KeyPressed(KEY_ESCAPE))
                 {
                     currentState = STATE_MENU;
                 }
@@ -561,7 +1439,10 @@ int main()
         }
         
         // Dessin
+        float updateMs = msSince(updateStart);
+        Clock::time_point drawStart = Clock::now();
         BeginDrawing();
+        frameArena.Reset();
         ClearBackground(SKYBLUE);
         
         switch (currentState)
@@ -569,7 +1450,7 @@ int main()
             case STATE_INTRO:
             {
                 // Background intro
-                DrawTexture(bgIntro, 0, 0, WHITE);
+                DrawStaticLayer(bgIntro);
                 
                 // Titre avec effet
                 float pulse = sinf(GetTime() * 3.0f) * 0.5f + 0.5f;
@@ -592,7 +1473,7 @@ int main()
             case STATE_MENU:
             {
                 // Background menu
-                DrawTexture(bgIntro, 0, 0, WHITE);
+                DrawStaticLayer(bgIntro);
                 
                 // Titre
                 DrawText("ZORO RUNNER", windowWidth/2 - 250, 50, 80, RED);
@@ -613,8 +1494,7 @@ int main()
                     
                     if (i == 2) // Option musique
                     {
-                        std::string musicText = std::string(menuItems[i]) + (musicOn ? "ON" : "OFF");
-                        DrawText(musicText.c_str(), windowWidth/2 - 100, yPos, 40, color);
+                        DrawText(frameArena.Format("%s%s", menuItems[i], musicOn ? "ON" : "OFF"), windowWidth/2 - 100, yPos, 40, color);
                     }
                     else
                     {
@@ -623,9 +1503,9 @@ int main()
                 }
                 
                 // Instructions
-                DrawText("Utilisez les fleches HAUT/BAS pour naviguer", windowWidth/2 - 300, 550, 25, GRAY);
-                DrawText("ENTRER pour selectionner", windowWidth/2 - 200, 600, 25, GRAY);
-                DrawText("ESPACE pour sauter en jeu", windowWidth/2 - 200, 630, 25, GRAY);
+                DrawCachedText(menuHelp[0], "Utilisez les fleches HAUT/BAS pour naviguer", windowWidth/2 - 300, 550, 25, GRAY);
+                DrawCachedText(menuHelp[1], "ENTRER pour selectionner", windowWidth/2 - 200, 600, 25, GRAY);
+                DrawCachedText(menuHelp[2], "ESPACE pour sauter en jeu", windowWidth/2 - 200, 630, 25, GRAY);
                 
                 break;
             }
@@ -635,23 +1515,23 @@ int main()
                 if (!collision)
                 {
                     // Background jeu
-                    DrawTexture(bgGame, 0, 0, WHITE);
+                    DrawStaticLayer(bgGame);
                     
                     // Items
                     for (int i = 0; i < NumOfItems; i++)
                     {
-                        DrawTextureRec(sake, items[i].rec, items[i].pos, WHITE);
+                        DrawTextureRec(sake, items[i].rec, InterpolatePos(items[i], simAlpha), WHITE);
                     }
                     
                     // Obstacles
                     for (int i = 0; i < NumOfKunais; i++)
                     {
-                        DrawTextureRec(kunai, kunais[i].rec, kunais[i].pos, WHITE);
+                        DrawTextureRec(kunai, kunais[i].rec, InterpolatePos(kunais[i], simAlpha), WHITE);
                     }
                     
                     for (int i = 0; i < NumOfShurikens; i++)
                     {
-                        DrawTextureRec(shuriken, shurikens[i].rec, shurikens[i].pos, WHITE);
+                        DrawTextureRec(shuriken, shurikens[i].rec, InterpolatePos(shurikens[i], simAlpha), WHITE);
                     }
                     
                     // Zoro
@@ -660,14 +1540,14 @@ int main()
                         // Animation de saut
                         Rectangle sourceRect = { zoroData.frame * zoroData.rec.width, 0, 
                                                 zoroData.rec.width, zoroData.rec.height };
-                        DrawTextureRec(zoroJump, sourceRect, zoroData.pos, WHITE);
+                        DrawTextureRec(zoroJump, sourceRect, InterpolatePos(zoroData, simAlpha), WHITE);
                     }
                     else
                     {
                         // Animation de marche
                         Rectangle sourceRect = { zoroData.frame * zoroData.rec.width, 0, 
                                                 zoroData.rec.width, zoroData.rec.height };
-                        DrawTextureRec(zoroWalk, sourceRect, zoroData.pos, WHITE);
+                        DrawTextureRec(zoroWalk, sourceRect, InterpolatePos(zoroData, simAlpha), WHITE);
                     }
                     
                     // Afficher l'attaque slash si active
@@ -679,13 +1559,13 @@ int main()
                     }
                     
                     // UI
-                    DrawText(TextFormat("SCORE: %d", score), 20, 20, 40, YELLOW);
-                    DrawText(TextFormat("VITESSE: %.0f", gameSpeed), 20, 70, 30, GREEN);
+                    DrawCachedText(hudScore, frameArena.Format("SCORE: %d", score), 20, 20, 40, YELLOW);
+                    DrawCachedText(hudSpeed, frameArena.Format("VITESSE: %.0f", gameSpeed), 20, 70, 30, GREEN);
                     
                     // Instructions en jeu
-                    DrawText("ESPACE: SAUTER", windowWidth - 250, 20, 25, WHITE);
-                    DrawText("A ou CLIC: ATTAQUER", windowWidth - 250, 50, 25, WHITE);
-                    DrawText("ECHAP: MENU", windowWidth - 250, 80, 25, WHITE);
+                    DrawCachedText(playHelp[0], "ESPACE: SAUTER", windowWidth - 250, 20, 25, WHITE);
+                    DrawCachedText(playHelp[1], "A ou CLIC: ATTAQUER", windowWidth - 250, 50, 25, WHITE);
+                    DrawCachedText(playHelp[2], "ECHAP: MENU", windowWidth - 250, 80, 25, WHITE);
                     
                     // Indicateur de cooldown d'attaque
                     if (attackCooldown > 0)
@@ -703,7 +1583,7 @@ int main()
                     DrawRectangle(0, 0, windowWidth, windowHeight, Color{0, 0, 0, 200});
                     
                     DrawText("GAME OVER", windowWidth/2 - 200, 100, 80, RED);
-                    DrawText(TextFormat("SCORE FINAL: %d", score), windowWidth/2 - 150, 200, 50, YELLOW);
+                    DrawText(frameArena.Format("SCORE FINAL: %d", score), windowWidth/2 - 150, 200, 50, YELLOW);
                     
                     // Vérifier si c'est un nouveau record
                     bool isNewHighScore = false;
@@ -747,10 +1627,10 @@ int main()
                         Color color = (i % 2 == 0) ? WHITE : LIGHTGRAY;
                         
                         // Rang
-                        DrawText(TextFormat("%d.", i + 1), windowWidth/2 - 350, yPos, 30, color);
+                        DrawText(frameArena.Format("%d.", i + 1), windowWidth/2 - 350, yPos, 30, color);
                         
                         // Score
-                        DrawText(TextFormat("%d", highScores[i].score), windowWidth/2 - 150, yPos, 30, color);
+                        DrawText(frameArena.Format("%d", highScores[i].score), windowWidth/2 - 150, yPos, 30, color);
                         
                         // Date
                         DrawText(highScores[i].date, windowWidth/2 + 100, yPos, 30, color);
@@ -762,9 +1642,18 @@ int main()
             }
         }
         
+        float drawMs = msSince(drawStart);
+        WaitForFrameDeadline();
         EndDrawing();
+        
+        RecordHitchFrame({msSince(frameStart), updateMs, drawMs, (int)currentState, score, gameSpeed, false});
+        // L'écriture d'un historique ne compte pas dans la frame suivante
+        frameStart = Clock::now();
     }
     
+    if (hitchRecorder.dumpIn >= 0) WriteHitchRecord();
+    endReplay();
+    
     // Sauvegarder les scores avant de quitter
     SaveHighScores(highScores);
     
@@ -780,8 +1669,15 @@ int main()
     UnloadTexture(sake);
     UnloadTexture(coin);
     
-    UnloadTexture(bgIntro);
-    UnloadTexture(bgGame);
+    UnloadRenderTexture(bgIntro);
+    UnloadRenderTexture(bgGame);
+    UnloadCachedText(hudScore);
+    UnloadCachedText(hudSpeed);
+    for (int i = 0; i < 3; i++)
+    {
+        UnloadCachedText(menuHelp[i]);
+        UnloadCachedText(playHelp[i]);
+    }
     
     UnloadSound(jumpSound);
     UnloadSound(collectSound);
@@ -789,8 +1685,12 @@ int main()
     UnloadSound(slashSound);
     UnloadMusicStream(bgMusic);
     
+    LogFrameJitter();
+    TraceLog(LOG_INFO, "ARENE DE FRAME : pic %d / %d octets, %d débordement(s)",
+             frameArena.highWater, FRAME_ARENA_BYTES, frameArena.overflows);
     CloseAudioDevice();
     CloseWindow();
+    assetPack.Close();
     
     return 0;
 }
\ No newline at end of file
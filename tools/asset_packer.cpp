@@ -0,0 +1,125 @@
+// ===============================
+// ASSET PACKER
+// ===============================
+// Offline tool run by "make pack" in each of the three games. Bundles every
+// file under the given folders into one indexed archive that AssetPack in
+// the game's Dino_game.cpp maps at startup, so the game opens one file
+// instead of one per asset. Each Makefile passes its own folders:
+//
+//   asset_packer assets.pak textures Sounds
+//   asset_packer assets.pak textures Sounds assets audio
+//
+// Layout: PackHeader, the index (one PackEntry per file, sorted by path so
+// the game can binary search it), then the file data, 16-byte aligned.
+// Both structs must match the ones in the three Dino_game.cpp.
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+
+const int PACK_ALIGN = 16;
+
+struct PackHeader {
+    char magic[4];
+    uint32_t count;
+};
+
+struct PackEntry {
+    uint32_t offset;
+    uint32_t size;
+    char path[120];
+};
+
+static void CollectFiles(const std::string& dir, std::vector<std::string>& files) {
+    DIR* d = opendir(dir.c_str());
+    if (!d) {
+        printf("asset_packer: skipping missing folder %s\n", dir.c_str());
+        return;
+    }
+    
+    while (dirent* e = readdir(d)) {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+        std::string path = dir + "/" + e->d_name;
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) continue;
+        if (S_ISDIR(info.st_mode)) CollectFiles(path, files);
+        else files.push_back(path);
+    }
+    closedir(d);
+}
+
+static bool ReadFile(const std::string& path, std::vector<unsigned char>& data) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data.resize(size > 0 ? (size_t)size : 0);
+    bool ok = data.empty() || fread(data.data(), 1, data.size(), f) == data.size();
+    fclose(f);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printf("usage: asset_packer <pack file> <folder>...\n");
+        return 1;
+    }
+    
+    std::vector<std::string> files;
+    for (int i = 2; i < argc; i++) CollectFiles(argv[i], files);
+    std::sort(files.begin(), files.end(), [](const std::string& a, const std::string& b) {
+        return strcmp(a.c_str(), b.c_str()) < 0;
+    });
+    
+    std::vector<PackEntry> entries(files.size());
+    std::vector<std::vector<unsigned char>> contents(files.size());
+    uint64_t offset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    for (size_t i = 0; i < files.size(); i++) {
+        if (files[i].size() >= sizeof(entries[i].path)) {
+            printf("asset_packer: path too long: %s\n", files[i].c_str());
+            return 1;
+        }
+        if (!ReadFile(files[i], contents[i])) {
+            printf("asset_packer: cannot read %s\n", files[i].c_str());
+            return 1;
+        }
+        
+        offset = (offset + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN;
+        if (offset + contents[i].size() > UINT32_MAX) {
+            printf("asset_packer: pack would exceed 4 GB\n");
+            return 1;
+        }
+        memset(&entries[i], 0, sizeof(PackEntry));
+        entries[i].offset = (uint32_t)offset;
+        entries[i].size = (uint32_t)contents[i].size();
+        strcpy(entries[i].path, files[i].c_str());
+        offset += contents[i].size();
+    }
+    
+    FILE* out = fopen(argv[1], "wb");
+    if (!out) {
+        printf("asset_packer: cannot write %s\n", argv[1]);
+        return 1;
+    }
+    
+    PackHeader header = {{'G', 'P', 'K', '1'}, (uint32_t)entries.size()};
+    fwrite(&header, sizeof(header), 1, out);
+    if (!entries.empty()) fwrite(entries.data(), sizeof(PackEntry), entries.size(), out);
+    
+    const unsigned char zeros[PACK_ALIGN] = {};
+    long written = (long)(sizeof(header) + entries.size() * sizeof(PackEntry));
+    for (size_t i = 0; i < entries.size(); i++) {
+        fwrite(zeros, 1, entries[i].offset - written, out);
+        fwrite(contents[i].data(), 1, contents[i].size(), out);
+        written = (long)(entries[i].offset + entries[i].size);
+    }
+    fclose(out);
+    
+    printf("asset_packer: %d files, %ld bytes -> %s\n", (int)entries.size(), written, argv[1]);
+    return 0;
+}